@@ -13,6 +13,8 @@
 #include "raop.h"
 #include "dnssd.h"
 #include "stream.h"
+#include "nal_scan.h"
+#include "mp4_concat.h"
 #include "logger.h"
 
 #endif /* AirTeacher_Bridging_Header_h */
@@ -32,7 +32,9 @@ final class AirPlayReceiver {
     /// Delegate for receiving decoded video data and connection events.
     protocol Delegate: AnyObject {
         /// Called when H.264/H.265 NAL unit data arrives from the client.
-        func receiver(_ receiver: AirPlayReceiver, didReceiveVideoData data: UnsafeBufferPointer<UInt8>, isH265: Bool, nalCount: Int, ntpTimeLocal: UInt64, ntpTimeRemote: UInt64)
+        /// `nalUnits` indexes the NAL units in `data` (offsets of the unit headers, after the start codes);
+        /// it is only valid for the duration of the call. `frameFlags` holds the `VIDEO_FRAME_*` flags.
+        func receiver(_ receiver: AirPlayReceiver, didReceiveVideoData data: UnsafeBufferPointer<UInt8>, nalUnits: UnsafeBufferPointer<video_nal_t>, frameFlags: UInt32, isH265: Bool, nalCount: Int, ntpTimeLocal: UInt64, ntpTimeRemote: UInt64)
 
         /// Called when audio data arrives from the client.
         func receiver(_ receiver: AirPlayReceiver, didReceiveAudioData data: UnsafeBufferPointer<UInt8>, codecType: UInt8)
@@ -297,7 +299,11 @@ private func airplay_video_process_callback(_ cls: UnsafeMutableRawPointer?, _ n
     let vd = data.pointee
     guard vd.data_len > 0, let rawData = vd.data else { return }
     let buffer = UnsafeBufferPointer(start: rawData, count: Int(vd.data_len))
-    receiver.delegate?.receiver(receiver, didReceiveVideoData: buffer, isH265: vd.is_h265, nalCount: Int(vd.nal_count), ntpTimeLocal: vd.ntp_time_local, ntpTimeRemote: vd.ntp_time_remote)
+    // The NAL index is a fixed C array (imported as a tuple); view it in place, without copying
+    let nalsOffset = MemoryLayout<video_decode_struct>.offset(of: \video_decode_struct.nals)!
+    let nals = UnsafeRawPointer(data).advanced(by: nalsOffset).assumingMemoryBound(to: video_nal_t.self)
+    let nalUnits = UnsafeBufferPointer(start: nals, count: Int(vd.nal_index_count))
+    receiver.delegate?.receiver(receiver, didReceiveVideoData: buffer, nalUnits: nalUnits, frameFlags: vd.frame_flags, isH265: vd.is_h265, nalCount: Int(vd.nal_count), ntpTimeLocal: vd.ntp_time_local, ntpTimeRemote: vd.ntp_time_remote)
 }
 
 private func airplay_audio_process(_ cls: UnsafeMutableRawPointer?, _ ntp: OpaquePointer?, _ data: UnsafeMutablePointer<audio_decode_struct>?) {
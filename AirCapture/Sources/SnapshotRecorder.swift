@@ -161,8 +161,11 @@ final class SnapshotRecorder {
     
     // MARK: - Video Consolidation
     
-    /// Rolling consolidation: Merge new segment videos with existing consolidated video.
+    /// Rolling consolidation: Append new segment videos to the consolidated video in place.
     /// This keeps disk usage minimal by maintaining only one consolidated file at a time.
+    /// The consolidated file is always a fragmented MP4 that `mp4_concat` can append to:
+    /// a segment whose format differs (e.g. after a resolution change) starts a new
+    /// consolidated part, and a consolidated file left by an older version is converted once.
     private func consolidateVideosRolling(in directory: URL) async {
         let fileManager = FileManager.default
         
@@ -177,87 +180,46 @@ final class SnapshotRecorder {
         
         Self.logger.info("SnapshotRecorder[\(self.slotIndex)] rolling consolidation: \(segmentFiles.count) segment(s) to merge")
         
-        // Output filename (always the same - gets replaced each time)
-        let consolidatedFilename = "\(serviceName)_CONSOLIDATED.mp4"
-        let consolidatedURL = directory.appendingPathComponent(consolidatedFilename)
-        let tempConsolidatedURL = directory.appendingPathComponent("\(serviceName)_TEMP_CONSOLIDATED.mp4")
-        
-        // Files to merge: existing consolidated (if exists) + all segment files
-        var filesToMerge: [URL] = []
-        if fileManager.fileExists(atPath: consolidatedURL.path) {
-            filesToMerge.append(consolidatedURL)
-        }
-        filesToMerge.append(contentsOf: segmentFiles)
-        
-        // Create composition
-        let composition = AVMutableComposition()
-        
-        guard let videoTrack = composition.addMutableTrack(withMediaType: .video, preferredTrackID: kCMPersistentTrackID_Invalid) else {
-            Self.logger.error("SnapshotRecorder[\(self.slotIndex)] failed to create video track for consolidation")
+        var consolidatedURL = currentConsolidatedURL(in: directory)
+        guard makeAppendable(consolidatedURL) else {
+            // Leave the segments for the next consolidation
             return
         }
         
-        var currentTime = CMTime.zero
-        
-        // Add each video to the composition
-        for videoURL in filesToMerge {
-            let asset = AVURLAsset(url: videoURL)
-            
-            guard let assetTrack = try? await asset.loadTracks(withMediaType: .video).first else {
-                Self.logger.warning("SnapshotRecorder[\(self.slotIndex)] failed to load track from \(videoURL.lastPathComponent)")
-                continue
-            }
-            
-            let duration = try? await asset.load(.duration)
-            let timeRange = CMTimeRange(start: .zero, duration: duration ?? .zero)
-            
-            do {
-                try videoTrack.insertTimeRange(timeRange, of: assetTrack, at: currentTime)
-                currentTime = CMTimeAdd(currentTime, duration ?? .zero)
-                Self.logger.debug("SnapshotRecorder[\(self.slotIndex)] merged \(videoURL.lastPathComponent)")
-            } catch {
-                Self.logger.error("SnapshotRecorder[\(self.slotIndex)] failed to insert \(videoURL.lastPathComponent): \(error.localizedDescription)")
-            }
+        // Only the box structure is written, so the cost does not grow with the footage
+        // already in the consolidated file
+        func append(_ url: URL) -> Int32 {
+            let result = mp4_concat_append_file(consolidatedURL.path, url.path)
+            guard result == MP4_CONCAT_ERR_MISMATCH else { return result }
+            // Another format: it goes on in a new consolidated part
+            consolidatedURL = nextConsolidatedURL(after: consolidatedURL, in: directory)
+            Self.logger.info("SnapshotRecorder[\(self.slotIndex)] \(url.lastPathComponent) has another format, starting \(consolidatedURL.lastPathComponent)")
+            return mp4_concat_append_file(consolidatedURL.path, url.path)
         }
-        
-        // Export the consolidated video to temp location
-        guard let exportSession = AVAssetExportSession(asset: composition, presetName: AVAssetExportPresetHighestQuality) else {
-            Self.logger.error("SnapshotRecorder[\(self.slotIndex)] failed to create export session")
-            return
-        }
-        
-        exportSession.outputURL = tempConsolidatedURL
-        exportSession.outputFileType = .mp4
-        
-        await exportSession.export()
-        
-        if exportSession.status == .completed {
-            Self.logger.info("SnapshotRecorder[\(self.slotIndex)] rolling consolidation completed")
-            
-            // Delete old consolidated file
-            if fileManager.fileExists(atPath: consolidatedURL.path) {
-                try? fileManager.removeItem(at: consolidatedURL)
-            }
-            
-            // Move temp consolidated to final location
-            do {
-                try fileManager.moveItem(at: tempConsolidatedURL, to: consolidatedURL)
-                Self.logger.debug("SnapshotRecorder[\(self.slotIndex)] moved temp consolidated to final location")
-            } catch {
-                Self.logger.error("SnapshotRecorder[\(self.slotIndex)] failed to move consolidated file: \(error.localizedDescription)")
+        for segmentURL in segmentFiles {
+            var result = append(segmentURL)
+            if result == MP4_CONCAT_ERR_FORMAT {
+                // Re-encode the segment on its own: the cost is that of the segment, never of
+                // the consolidated file
+                if let reencodedURL = await reencode(segmentURL) {
+                    result = append(reencodedURL)
+                    try? fileManager.removeItem(at: reencodedURL)
+                }
+                if result == MP4_CONCAT_ERR_FORMAT {
+                    // Not a usable video: set it aside rather than retry it every time
+                    Self.logger.error("SnapshotRecorder[\(self.slotIndex)] \(segmentURL.lastPathComponent) is not a usable video, setting it aside")
+                    try? fileManager.moveItem(at: segmentURL, to: segmentURL.deletingPathExtension().appendingPathExtension("unmerged"))
+                    continue
+                }
             }
-            
-            // Delete all segment files
-            for segmentURL in segmentFiles {
-                try? fileManager.removeItem(at: segmentURL)
+            guard result == MP4_CONCAT_OK else {
+                Self.logger.warning("SnapshotRecorder[\(self.slotIndex)] could not append \(segmentURL.lastPathComponent) (\(result)), will retry")
+                removeIfEmpty(consolidatedURL)
+                return
             }
-            Self.logger.debug("SnapshotRecorder[\(self.slotIndex)] deleted \(segmentFiles.count) segment file(s)")
-            
-        } else if let error = exportSession.error {
-            Self.logger.error("SnapshotRecorder[\(self.slotIndex)] rolling consolidation failed: \(error.localizedDescription)")
-            // Clean up temp file on failure
-            try? fileManager.removeItem(at: tempConsolidatedURL)
+            try? fileManager.removeItem(at: segmentURL)
         }
+        Self.logger.info("SnapshotRecorder[\(self.slotIndex)] rolling consolidation completed")
     }
     
     /// Consolidate all MP4 files in the directory into a single video.
@@ -265,31 +227,103 @@ final class SnapshotRecorder {
     private func consolidateVideos(in directory: URL) async {
         let fileManager = FileManager.default
         
-        // Check if we already have a CONSOLIDATED file
-        let consolidatedFilename = "\(serviceName)_CONSOLIDATED.mp4"
-        let consolidatedURL = directory.appendingPathComponent(consolidatedFilename)
-        
         // Get all segment MP4 files (excluding CONSOLIDATED)
         let segmentFiles = (try? fileManager.contentsOfDirectory(at: directory, includingPropertiesForKeys: nil)
             .filter({ $0.pathExtension == "mp4" && !$0.lastPathComponent.contains("CONSOLIDATED") })
             .sorted(by: { $0.lastPathComponent < $1.lastPathComponent })) ?? []
         
-        // If we have a consolidated file and no segments, we're done
-        if fileManager.fileExists(atPath: consolidatedURL.path) && segmentFiles.isEmpty {
-            Self.logger.info("SnapshotRecorder[\(self.slotIndex)] consolidated file already exists, no segments to merge")
-            return
-        }
-        
-        // If we only have segments, merge them
         if !segmentFiles.isEmpty {
             Self.logger.info("SnapshotRecorder[\(self.slotIndex)] final consolidation: merging \(segmentFiles.count) remaining segment(s)")
             await consolidateVideosRolling(in: directory)
-        } else if !fileManager.fileExists(atPath: consolidatedURL.path) {
+        } else if fileManager.fileExists(atPath: currentConsolidatedURL(in: directory).path) {
+            Self.logger.info("SnapshotRecorder[\(self.slotIndex)] consolidated file already exists, no segments to merge")
+        } else {
             // No videos at all
             Self.logger.info("SnapshotRecorder[\(self.slotIndex)] no videos found for consolidation")
         }
     }
     
+    /// The consolidated part new segments go into: `<name>_CONSOLIDATED.mp4`, then
+    /// `<name>_CONSOLIDATED_002.mp4`, ... after format changes.
+    private func currentConsolidatedURL(in directory: URL) -> URL {
+        let first = directory.appendingPathComponent("\(serviceName)_CONSOLIDATED.mp4")
+        let parts = (try? FileManager.default.contentsOfDirectory(at: directory, includingPropertiesForKeys: nil)
+            .filter({ $0.lastPathComponent.hasPrefix("\(serviceName)_CONSOLIDATED_") && $0.pathExtension == "mp4"
+                && !$0.lastPathComponent.hasSuffix(".legacy.mp4") })
+            .sorted(by: { $0.lastPathComponent < $1.lastPathComponent })) ?? []
+        return parts.last ?? first
+    }
+    
+    private func nextConsolidatedURL(after url: URL, in directory: URL) -> URL {
+        let prefix = "\(serviceName)_CONSOLIDATED_"
+        let name = url.deletingPathExtension().lastPathComponent
+        let part = name.hasPrefix(prefix) ? (Int(name.dropFirst(prefix.count)) ?? 1) : 1
+        return directory.appendingPathComponent(String(format: "%@%03d.mp4", prefix, part + 1))
+    }
+    
+    /// Makes sure the consolidated file can be appended to: a regular MP4 (from an older
+    /// version, which re-encoded it with AVAssetExportSession) is converted once into a
+    /// fragmented one, copying its samples without re-encoding.  One that cannot be
+    /// converted is kept as `<name>_CONSOLIDATED.legacy.mp4`, and a new one is started.
+    private func makeAppendable(_ consolidatedURL: URL) -> Bool {
+        let fileManager = FileManager.default
+        guard fileManager.fileExists(atPath: consolidatedURL.path) else { return true }
+        var concat: OpaquePointer?
+        let result = mp4_concat_open(consolidatedURL.path, &concat)
+        if result == MP4_CONCAT_OK {
+            mp4_concat_close(concat)
+            return true
+        }
+        guard result == MP4_CONCAT_ERR_FORMAT else {
+            Self.logger.error("SnapshotRecorder[\(self.slotIndex)] cannot open \(consolidatedURL.lastPathComponent) (\(result))")
+            return false
+        }
+        let name = consolidatedURL.deletingPathExtension().lastPathComponent
+        let legacyURL = consolidatedURL.deletingLastPathComponent().appendingPathComponent("\(name).legacy.mp4")
+        let convertedURL = consolidatedURL.deletingPathExtension().appendingPathExtension("converting")
+        try? fileManager.removeItem(at: convertedURL)
+        defer { try? fileManager.removeItem(at: convertedURL) }
+        do {
+            try fileManager.moveItem(at: consolidatedURL, to: legacyURL)
+        } catch {
+            Self.logger.error("SnapshotRecorder[\(self.slotIndex)] cannot set \(consolidatedURL.lastPathComponent) aside: \(error.localizedDescription)")
+            return false
+        }
+        let converted = mp4_concat_append_file(convertedURL.path, legacyURL.path)
+        if converted == MP4_CONCAT_OK, (try? fileManager.moveItem(at: convertedURL, to: consolidatedURL)) != nil {
+            try? fileManager.removeItem(at: legacyURL)
+            Self.logger.info("SnapshotRecorder[\(self.slotIndex)] converted \(consolidatedURL.lastPathComponent) to a fragmented MP4")
+        } else {
+            try? fileManager.removeItem(at: consolidatedURL)
+            Self.logger.warning("SnapshotRecorder[\(self.slotIndex)] could not convert \(consolidatedURL.lastPathComponent) (\(converted)), kept as \(legacyURL.lastPathComponent)")
+        }
+        return true
+    }
+    
+    /// Re-encodes a segment mp4_concat cannot read into a regular MP4, in the temporary directory.
+    private func reencode(_ segmentURL: URL) async -> URL? {
+        let reencodedURL = FileManager.default.temporaryDirectory.appendingPathComponent("\(UUID().uuidString).mp4")
+        guard let exportSession = AVAssetExportSession(asset: AVURLAsset(url: segmentURL), presetName: AVAssetExportPresetHighestQuality) else {
+            return nil
+        }
+        exportSession.outputURL = reencodedURL
+        exportSession.outputFileType = .mp4
+        await exportSession.export()
+        guard exportSession.status == .completed else {
+            try? FileManager.default.removeItem(at: reencodedURL)
+            return nil
+        }
+        return reencodedURL
+    }
+    
+    /// A failed first append leaves an empty consolidated file behind
+    private func removeIfEmpty(_ url: URL) {
+        if let attributes = try? FileManager.default.attributesOfItem(atPath: url.path),
+           (attributes[.size] as? NSNumber)?.int64Value == 0 {
+            try? FileManager.default.removeItem(at: url)
+        }
+    }
+    
     // MARK: - Private Helpers
     
     private func captureSnapshot() {
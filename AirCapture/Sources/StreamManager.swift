@@ -401,9 +401,9 @@ private final class ReceiverDelegateBridge: AirPlayReceiver.Delegate, VideoDecod
 
     // MARK: - AirPlayReceiver.Delegate
 
-    func receiver(_ receiver: AirPlayReceiver, didReceiveVideoData data: UnsafeBufferPointer<UInt8>, isH265: Bool, nalCount: Int, ntpTimeLocal: UInt64, ntpTimeRemote: UInt64) {
+    func receiver(_ receiver: AirPlayReceiver, didReceiveVideoData data: UnsafeBufferPointer<UInt8>, nalUnits: UnsafeBufferPointer<video_nal_t>, frameFlags: UInt32, isH265: Bool, nalCount: Int, ntpTimeLocal: UInt64, ntpTimeRemote: UInt64) {
         // Decode for UI display (hardware-accelerated, very fast)
-        decoder.decode(nalData: data, nalCount: nalCount, ntpTimeLocal: ntpTimeLocal)
+        decoder.decode(nalData: data, nalUnits: nalUnits, frameFlags: frameFlags, nalCount: nalCount, ntpTimeLocal: ntpTimeLocal)
     }
 
     func receiver(_ receiver: AirPlayReceiver, didReceiveAudioData data: UnsafeBufferPointer<UInt8>, codecType: UInt8) {
@@ -124,8 +124,10 @@ final class StreamRecorder {
     /// Feed raw H.264 NAL data from the AirPlay stream.
     /// - Parameters:
     ///   - nalData: Raw NAL data in Annex-B format (start codes: 0x00 0x00 0x01 or 0x00 0x00 0x00 0x01).
+    ///   - nalUnits: NAL unit index from `video_decode_struct.nals`, if available (avoids rescanning for start codes).
+    ///   - frameFlags: `VIDEO_FRAME_*` flags of the frame.
     ///   - ntpTimeLocal: Local NTP timestamp (nanoseconds).
-    func appendNALData(_ nalData: UnsafeBufferPointer<UInt8>, ntpTimeLocal: UInt64) {
+    func appendNALData(_ nalData: UnsafeBufferPointer<UInt8>, nalUnits index: UnsafeBufferPointer<video_nal_t>? = nil, frameFlags: UInt32, ntpTimeLocal: UInt64) {
         guard isRecording else {
             Self.logger.debug("Recorder[\(self.slotIndex)] ignoring data - not recording")
             return
@@ -133,8 +135,15 @@ final class StreamRecorder {
 
         Self.logger.debug("Recorder[\(self.slotIndex)] received \(nalData.count) bytes")
         
-        // Parse NAL units
-        let nalUnits = parseAnnexB(Array(nalData))
+        // Use the index built while the frame was received; only rescan the
+        // Annex-B stream when it is missing or incomplete
+        let bytes = Array(nalData)
+        let nalUnits: [ArraySlice<UInt8>]
+        if let index, index.count > 0, frameFlags & UInt32(VIDEO_FRAME_NAL_INDEX_TRUNCATED) == 0 {
+            nalUnits = index.map { bytes[Int($0.offset)..<Int($0.offset + $0.length)] }
+        } else {
+            nalUnits = parseAnnexB(bytes)
+        }
         Self.logger.debug("Recorder[\(self.slotIndex)] parsed \(nalUnits.count) NAL units")
 
         // Collect all VCL (Video Coding Layer) NAL units for this frame
@@ -386,45 +395,17 @@ final class StreamRecorder {
     // MARK: - Annex-B Parser
 
     private func parseAnnexB(_ buffer: [UInt8]) -> [ArraySlice<UInt8>] {
-        var nalUnits: [ArraySlice<UInt8>] = []
-        var i = 0
-        let count = buffer.count
-
-        while i < count {
-            // Find start code: 0x00 0x00 0x01 or 0x00 0x00 0x00 0x01
-            var startCodeLen = 0
-            if i + 2 < count && buffer[i] == 0 && buffer[i+1] == 0 && buffer[i+2] == 1 {
-                startCodeLen = 3
-            } else if i + 3 < count && buffer[i] == 0 && buffer[i+1] == 0 && buffer[i+2] == 0 && buffer[i+3] == 1 {
-                startCodeLen = 4
-            }
-
-            if startCodeLen > 0 {
-                let nalStart = i + startCodeLen
-                // Find next start code or end of buffer
-                var nalEnd = count
-                var j = nalStart + 1
-                while j + 2 < count {
-                    if buffer[j] == 0 && buffer[j+1] == 0 {
-                        if buffer[j+2] == 1 {
-                            nalEnd = j
-                            break
-                        } else if j + 3 < count && buffer[j+2] == 0 && buffer[j+3] == 1 {
-                            nalEnd = j
-                            break
-                        }
-                    }
-                    j += 1
-                }
-                if nalStart < nalEnd {
-                    nalUnits.append(buffer[nalStart..<nalEnd])
-                }
-                i = nalEnd
-            } else {
-                i += 1
+        guard !buffer.isEmpty else { return [] }
+        var index = [video_nal_t](repeating: video_nal_t(), count: Int(VIDEO_MAX_NALS))
+        var count = buffer.withUnsafeBufferPointer {
+            Int(nal_scan_annexb($0.baseAddress, Int32($0.count), false, &index, Int32(index.count)))
+        }
+        if count > index.count {
+            index = [video_nal_t](repeating: video_nal_t(), count: count)
+            count = buffer.withUnsafeBufferPointer {
+                Int(nal_scan_annexb($0.baseAddress, Int32($0.count), false, &index, Int32(index.count)))
             }
         }
-
-        return nalUnits
+        return index.prefix(count).map { buffer[Int($0.offset)..<Int($0.offset + $0.length)] }
     }
 }
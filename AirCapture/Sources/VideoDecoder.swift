@@ -81,13 +81,23 @@ final class VideoDecoder {
     ///
     /// - Parameters:
     ///   - nalData: Raw NAL data buffer (Annex-B format from UxPlay).
+    ///   - nalUnits: NAL unit index built by UxPlay (`video_decode_struct.nals`); may be empty.
+    ///   - frameFlags: `VIDEO_FRAME_*` flags of the frame.
     ///   - nalCount: Number of NAL units in the buffer.
     ///   - ntpTimeLocal: Local NTP timestamp.
-    func decode(nalData: UnsafeBufferPointer<UInt8>, nalCount: Int, ntpTimeLocal: UInt64) {
+    func decode(nalData: UnsafeBufferPointer<UInt8>, nalUnits index: UnsafeBufferPointer<video_nal_t>, frameFlags: UInt32, nalCount: Int, ntpTimeLocal: UInt64) {
         guard nalData.count > 0 else { return }
-
-        // Parse NAL units from Annex-B stream
-        let nalUnits = parseAnnexB(nalData)
+        guard frameFlags & UInt32(VIDEO_FRAME_INVALID) == 0 else { return }
+
+        // Use the index built while the frame was received; only rescan the
+        // Annex-B stream when it is incomplete
+        let nalUnits: [ArraySlice<UInt8>]
+        if index.count > 0 && frameFlags & UInt32(VIDEO_FRAME_NAL_INDEX_TRUNCATED) == 0 {
+            let bytes = Array(nalData)
+            nalUnits = index.map { bytes[Int($0.offset)..<Int($0.offset + $0.length)] }
+        } else {
+            nalUnits = parseAnnexB(nalData)
+        }
 
         for nalUnit in nalUnits {
             guard nalUnit.count > 0 else { continue }
@@ -359,46 +369,14 @@ final class VideoDecoder {
 
     /// Parse an Annex-B byte stream into individual NAL units (without start codes).
     private func parseAnnexB(_ buffer: UnsafeBufferPointer<UInt8>) -> [ArraySlice<UInt8>] {
-        let bytes = Array(buffer)
-        var nalUnits: [ArraySlice<UInt8>] = []
-        var i = 0
-        let count = bytes.count
-
-        while i < count {
-            // Find start code: 0x00 0x00 0x01 or 0x00 0x00 0x00 0x01
-            var startCodeLen = 0
-            if i + 2 < count && bytes[i] == 0 && bytes[i+1] == 0 && bytes[i+2] == 1 {
-                startCodeLen = 3
-            } else if i + 3 < count && bytes[i] == 0 && bytes[i+1] == 0 && bytes[i+2] == 0 && bytes[i+3] == 1 {
-                startCodeLen = 4
-            }
-
-            if startCodeLen > 0 {
-                let nalStart = i + startCodeLen
-                // Find next start code or end of buffer
-                var nalEnd = count
-                var j = nalStart + 1
-                while j + 2 < count {
-                    if bytes[j] == 0 && bytes[j+1] == 0 {
-                        if bytes[j+2] == 1 {
-                            nalEnd = j
-                            break
-                        } else if j + 3 < count && bytes[j+2] == 0 && bytes[j+3] == 1 {
-                            nalEnd = j
-                            break
-                        }
-                    }
-                    j += 1
-                }
-                if nalStart < nalEnd {
-                    nalUnits.append(bytes[nalStart..<nalEnd])
-                }
-                i = nalEnd
-            } else {
-                i += 1
-            }
+        guard let base = buffer.baseAddress, buffer.count > 0 else { return [] }
+        var index = [video_nal_t](repeating: video_nal_t(), count: Int(VIDEO_MAX_NALS))
+        var count = Int(nal_scan_annexb(base, Int32(buffer.count), isH265, &index, Int32(index.count)))
+        if count > index.count {
+            index = [video_nal_t](repeating: video_nal_t(), count: count)
+            count = Int(nal_scan_annexb(base, Int32(buffer.count), isH265, &index, Int32(index.count)))
         }
-
-        return nalUnits
+        let bytes = Array(buffer)
+        return index.prefix(count).map { bytes[Int($0.offset)..<Int($0.offset + $0.length)] }
     }
 }